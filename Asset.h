@@ -11,22 +11,38 @@
 
 #include "AssetNodeOptions.h"
 #include "OutputObject.h"
+#include "util.h"
 
 #include <memory>
+#include <string>
+#include <unordered_set>
 #include <vector>
 
 class Inputs;
+class MaterialNodeIndex;
 class OutputMaterial;
 class ParmNameCache;
+class ParmChoiceCache;
+class AnimCurveCache;
 
 class Asset
 {
 public:
-    Asset(const MString &otlFilePath, const MString &assetName);
+    // The asset is created in session, or in the main session if session is
+    // NULL.
+    Asset(const MString &otlFilePath,
+          const MString &assetName,
+          Util::HAPISession *session = NULL);
     ~Asset();
 
     bool isValid() const;
 
+    // The session that the asset lives in, or NULL for the main session. Node
+    // ids and string handles of the asset are only valid in that session, so
+    // it has to be bound with Util::ScopedHAPISession while accessing the
+    // asset.
+    Util::HAPISession *getSession() const { return mySession; }
+
     MString getOTLFilePath() const;
     MString getAssetName() const;
     MString getAssetHelpText() const;
@@ -51,25 +67,72 @@ public:
                     AssetNodeOptions::AccessorDataBlock &options,
                     bool &needToSyncOutputs,
                     const bool needToRecomputeOutputData);
+
+    // compute() split into its steps, so that the cook can run in the
+    // background. startCook() returns right away if the session has a cooking
+    // thread.
+    bool startCook(AssetNodeOptions::AccessorDataBlock &options);
+    MStatus finishCook();
+
+    // A session only runs one background cook at a time, and nothing else
+    // should be cooked or set in the session while it runs.
+    // reserveBackgroundCook() returns false if another asset's cook is
+    // running, and isBackgroundCookBlocked() tells when that's over. After a
+    // successful reservation, the inputs and parms can be set before
+    // startBackgroundCook(). updateBackgroundCook() returns false while the
+    // cook is running. Once it's over, cookCompleted tells whether this asset
+    // was actually cooked. cancelBackgroundCook() only interrupts the running
+    // cook if it belongs to this asset. waitForBackgroundCook() finishes the
+    // running cook of the session, whichever asset it belongs to, before the
+    // session is used for anything else.
+    bool reserveBackgroundCook();
+    bool isBackgroundCookBlocked() const;
+    bool startBackgroundCook(AssetNodeOptions::AccessorDataBlock &options);
+    bool updateBackgroundCook(bool &cookCompleted);
+    void cancelBackgroundCook();
+    MStatus finishBackgroundCook();
+    static void waitForBackgroundCook();
+    MStatus computeOutputs(const MPlug &plug,
+                           MDataBlock &data,
+                           AssetNodeOptions::AccessorDataBlock &options,
+                           bool &needToSyncOutputs,
+                           const bool needToRecomputeOutputData);
     void computeMaterial(const MPlug &plug,
                          MDataBlock &data,
                          bool bakeTextures,
                          bool &needToSyncOutputs);
 
+    // Returns the snapshot of the parm layout. It's only fetched again when
+    // the layout could have changed.
+    const std::vector<HAPI_ParmInfo> &getParmInfos();
+    void invalidateParmLayout();
+
     void fillParmNameCache();
     void getParmValues(MDataBlock &dataBlock,
                        const MFnDependencyNode &nodeFn,
-                       const std::vector<MObject> *attrs);
+                       const Util::ParmAttributeSet *attrs,
+                       bool onlyChangedParms);
 
     void setParmValues(MDataBlock &dataBlock,
                        const MFnDependencyNode &nodeFn,
-                       const std::vector<MObject> *attrs,
-                       bool checkMismatch);
+                       const Util::ParmAttributeSet *attrs,
+                       bool checkMismatch,
+                       bool animatedParmsAsCurves);
 
     MString getAttrNameFromParm(const HAPI_ParmInfo &parmInfo) const;
 
 private:
+    void fillCookOptions(AssetNodeOptions::AccessorDataBlock &options);
+    bool cookNode();
+    int getTotalCookCount() const;
+    void releaseBackgroundCook();
+    void recordBackgroundCook();
+
     void update();
+    void fetchParmInfos();
+    bool updateChangedParms();
+    void findReadbackCandidates();
+    bool readbackValuesChanged(const HAPI_ParmInfo &parmInfo);
 
     void computeInstancerObjects(const MPlug &plug,
                                  MDataBlock &data,
@@ -90,6 +153,8 @@ private:
     typedef std::vector<OutputObject *> OutputObjects;
     typedef std::vector<OutputMaterial *> OutputMaterials;
 
+    Util::HAPISession *mySession;
+
     MTime myTime;
     MString myAssetName;
     MString myAssetHelpText;
@@ -100,12 +165,40 @@ private:
 
     HAPI_NodeInfo myNodeInfo;
 
+    HAPI_CookOptions myCookOptions;
+    // the totalCookCount of the node when the last cook was started
+    int myCookCountAtStart;
+    // the result of the last background cook, once it's over
+    bool myBackgroundCookOver;
+    bool myBackgroundCookCompleted;
+    // the cook status of the last background cook, if it failed
+    MString myBackgroundCookError;
+
     Inputs *myAssetInputs;
     OutputObjects myObjects; // the OutputObject class contains a 1 to 1 map
                              // with HAPI_ObjectInfos.
 
     OutputMaterials myMaterials;
+    std::unique_ptr<MaterialNodeIndex> myMaterialNodeIndex;
     std::unique_ptr<ParmNameCache> myParmNameCache;
+    std::unique_ptr<ParmChoiceCache> myParmChoiceCache;
+    std::unique_ptr<AnimCurveCache> myAnimCurveCache;
+
+    std::vector<HAPI_ParmInfo> myParmInfos;
+    bool myParmLayoutDirty;
+    int myParmLayoutVersion;
+    int myParmNameCacheVersion;
+
+    // The parms that can change during a cook, as indices into myParmInfos,
+    // and their values from the last readback. They're found again whenever
+    // the layout changes.
+    std::vector<size_t> myReadbackCandidates;
+    std::vector<int> myReadbackIntValues;
+    std::vector<float> myReadbackFloatValues;
+    std::vector<std::string> myReadbackStringValues;
+    int myReadbackLayoutVersion;
+    bool myReadbackAllParms;
+    std::unordered_set<HAPI_ParmId> myChangedParms;
 };
 
 #endif
@@ -13,10 +13,17 @@
 #endif
 
 #include <maya/MMessage.h> 
+#include <maya/MNodeMessage.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MPlugArray.h>
 #include <maya/MTypeId.h>
 
+#include <unordered_map>
 #include <vector>
 
+#include "AssetNodeOptions.h"
+#include "util.h"
+
 class Asset;
 
 // Prefixes that we use to determine what type of tag created the associated
@@ -42,6 +49,13 @@ public:
     static void nodeAdded(MObject &node, void *clientData);
     static void nodeRemoved(MObject &node, void *clientData);
 
+    // The assets of nodes that are read from a file are only created after
+    // the file is read, once their input connections decide their session.
+    static void createDeferredAssets(void *clientData);
+    static void attributeAddedOrRemoved(MNodeMessage::AttributeMessage msg,
+                                        MPlug &plug,
+                                        void *clientData);
+
 public:
     AssetNode();
     virtual ~AssetNode();
@@ -70,6 +84,9 @@ public:
 
     virtual MStatus setDependentsDirty(const MPlug &plugBeingDirtied,
                                        MPlugArray &affectedPlugs);
+    virtual MStatus connectionMade(const MPlug &plug,
+                                   const MPlug &otherPlug,
+                                   bool asSrc);
     virtual MStatus connectionBroken(const MPlug &plug,
                                      const MPlug &otherPlug,
                                      bool asSrc);
@@ -78,6 +95,10 @@ public:
 #if MAYA_API_VERSION >= 201600
     virtual MStatus preEvaluation(const MDGContext &context,
                                   const MEvaluationNode &evaluationNode);
+
+    // Assets in different sessions are evaluated at the same time. Assets in
+    // the same session wait for each other in Util::ScopedHAPISession.
+    virtual SchedulingType schedulingType() const;
 #endif
 
     Asset *getAsset() const;
@@ -88,8 +109,26 @@ public:
     void getParmValues();
 
     int autoSyncId() const { return myAutoSyncId; }
+
+    // Timer callbacks have to be registered on the main thread, so compute()
+    // defers this to an idle houdiniAsset -backgroundCookPoll.
+    void startBackgroundCookPoll();
     void setExtraAutoSync(bool needs);
 
+    // What an output object looked like when it was last synced. A sync keeps
+    // the objects that still look the same, instead of recreating them.
+    struct SyncedObject
+    {
+        MObjectHandle objectTransform;
+        size_t signature;
+        unsigned int childCount;
+        bool hasGeos;
+    };
+
+    const SyncedObject *findSyncedObject(const MObject &objectTransform) const;
+    void addSyncedObject(const SyncedObject &syncedObject);
+    void pruneSyncedObjects();
+
 private:
     Asset *myAsset;
     bool isAssetValid() const;
@@ -97,8 +136,13 @@ private:
     void createAsset();
     void destroyAsset();
 
+    // Node inputs are created in the main session, so only assets without any
+    // of them can live in a pooled session.
+    bool isNodeInputPlug(const MPlug &plug) const;
+    bool hasNodeInputs() const;
+
     void setParmValues(MDataBlock &data, bool onlyDirtyParms = true);
-    void getParmValues(MDataBlock &data);
+    void getParmValues(MDataBlock &data, bool onlyChangedParms = false);
 
     MString myOTLFilePath;
     MString myAssetName;
@@ -109,15 +153,59 @@ private:
     bool myNeedToMarshalInput;
     bool myNeedToRecomputeOutputData;
 
+    static std::vector<MObjectHandle> theDeferredAssets;
+
     int myAutoSyncId;
     int myExtraAutoSync;
+    // Keyed by MObjectHandle::hashCode() of the object transform.
+    typedef std::unordered_multimap<unsigned int, SyncedObject> SyncedObjects;
+    SyncedObjects mySyncedObjects;
     bool mySetAllParmsForEM;
 
-    typedef std::vector<MObject> MObjectVector;
-    MObjectVector myDirtyParmAttributes;
+    Util::ParmAttributeSet myDirtyParmAttributes;
 
     MCallbackId myCallbackId;
 
+    // Cached for setDependentsDirty(), which is called for every plug that's
+    // being dirtied.
+    const MPlugArray &getOutputPlugs();
+    MObject getParmAttr();
+
+    MPlug myBakeOutputTexturesPlug;
+    MPlug myPreserveScalePlug;
+    MObject myParmAttrObj;
+    bool myParmAttrCached;
+    MCallbackId myAttributeAddedOrRemovedCallbackId;
+
+    // All the plugs under output, and the sizes of the arrays among them.
+    // The plugs are gathered again whenever one of the arrays is resized.
+    MPlugArray myOutputPlugs;
+    MPlugArray myOutputArrayPlugs;
+    std::vector<unsigned int> myOutputArraySizes;
+
+    // With cookInBackground, compute() only starts the cook, and a timer
+    // callback dirties the outputs once the cook is done. If another asset is
+    // cooking in the background in the same session, compute() waits for it
+    // without touching the session.
+    enum BackgroundCookState
+    {
+        BackgroundCookIdle,
+        BackgroundCookWaiting,
+        BackgroundCooking,
+        BackgroundCookDone
+    };
+
+    bool useBackgroundCook(AssetNodeOptions::AccessorDataBlock &options) const;
+    MStatus keepOutputsForBackgroundCook(const MPlug &plug, MDataBlock &data);
+    static void backgroundCookPoll(float elapsedTime,
+                                   float lastTime,
+                                   void *clientData);
+    void stopBackgroundCookPoll();
+    void checkBackgroundCook();
+
+    BackgroundCookState myBackgroundCookState;
+    MCallbackId myBackgroundCookCallbackId;
+
 public:
     static MObject inTime;
 
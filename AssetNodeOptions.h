@@ -23,6 +23,8 @@ NODE_OPTION(bakeOutputTextures, bool, true)
 NODE_OPTION(preserveScale, bool, false)
 NODE_OPTION(alwaysMergeInputGeometry, bool, false)
 NODE_OPTION(packBeforeMerge, bool, false)
+NODE_OPTION(animatedParmsAsCurves, bool, false)
+NODE_OPTION(cookInBackground, bool, false)
 
 NODE_OPTION(useInstancerNode, bool, true)
 
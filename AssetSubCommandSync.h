@@ -20,7 +20,9 @@ public:
 
     void setSyncOutputHidden();
     void setSyncOutputTemplatedGeos();
-    void deleteMaterials(MPlug &materialPlug);
+    void deleteMaterials(MPlug &materialPlug,
+                         std::vector<MObject> &deletedNodes);
+    void deleteNode(const MObject &node, std::vector<MObject> &deletedNodes);
 
     virtual MStatus doIt();
     virtual MStatus redoIt();
@@ -1,18 +1,27 @@
 #ifndef __Input_h__
 #define __Input_h__
 
+#include <map>
+#include <string>
 #include <vector>
 
 #include <maya/MCallbackIdArray.h>
 #include <maya/MDataBlock.h>
 #include <maya/MDataHandle.h>
+#include <maya/MMatrix.h>
 #include <maya/MMessage.h>
 #include <maya/MPlug.h>
+#include <maya/MPlugArray.h>
 
 #include <HAPI/HAPI_Common.h>
 
 class Input;
 
+namespace Util
+{
+class HAPISession;
+}
+
 class Inputs
 {
 public:
@@ -43,6 +52,13 @@ public:
 
     static Input *createAssetInput(AssetInputType assetInputType);
 
+    // Hash everything that setInputGeo() would marshal. Returns false if the
+    // input type cannot be shared.
+    static bool hashInputGeo(AssetInputType assetInputType,
+                             MDataBlock &dataBlock,
+                             const MPlug &plug,
+                             size_t &hash);
+
 public:
     Input();
     virtual ~Input();
@@ -58,7 +74,11 @@ public:
 
     void setInputName(HAPI_AttributeOwner owner, int count, const MPlug &plug);
 
+    void addGeoPlug(const MPlug &plug);
+    void removeGeoPlug(const MPlug &plug);
+
     void setInputTransform(MDataHandle &dataHandle);
+    void setInputTransform(const MMatrix &transformMatrix);
 
     virtual void setInputGeo(MDataBlock &dataBlock, const MPlug &plug) = 0;
 
@@ -69,6 +89,10 @@ public:
                                     const MPlug &pointGroupPlug);
 
 protected:
+    // Whether preserveScale is applied as a scale on the object transform,
+    // rather than by scaling the data itself.
+    virtual bool preserveScaleOnTransform() const { return true; }
+
     void setTransformNodeId(HAPI_NodeId nodeId) { myTransformNodeId = nodeId; };
     void setGeometryNodeId(HAPI_NodeId nodeId) { myGeometryNodeId = nodeId; };
 
@@ -88,10 +112,68 @@ private:
     HAPI_NodeId myTransformNodeId;
     HAPI_NodeId myGeometryNodeId;
 
-    MPlug myGeoPlug;
+    MPlugArray myGeoPlugs;
 
     MCallbackIdArray myNameChangedCallbackIds;
     MObject myNameChangedCallbackNode;
 };
 
+// Registry of the inputs that can be shared between several input nodes, per
+// session. An input is keyed by the source plug and a hash of the input node
+// settings, including the transform. Once an input is shared, the hash of the
+// source data is kept with it, so that an animated source is still uploaded
+// only once per change, into the same HAPI input node.
+class InputRegistry
+{
+public:
+    typedef std::pair<std::string, size_t> Key;
+
+    // Returns the input for key, and releases previousKey if it's not NULL.
+    // needToUpload is set if the input is new, or was reused from
+    // previousKey. An existing input is left to updateContent().
+    static Input *acquire(const Key &key,
+                          const Key *previousKey,
+                          Input::AssetInputType assetInputType,
+                          bool &needToUpload);
+    static void release(const Key &key);
+
+    // Returns NULL if the input of key is gone, for example because its
+    // session was closed.
+    static Input *find(const Key &key);
+    static bool isShared(const Key &key);
+
+    // Records contentHash for the input of key. Returns true if it differs
+    // from the data that was last uploaded.
+    static bool updateContent(const Key &key, size_t contentHash);
+
+    // Drops the inputs of a session that is being closed.
+    static void clearSession(Util::HAPISession *session);
+
+private:
+    struct Entry
+    {
+        Input *input;
+        int refCount;
+        // The hash is only kept while the input is shared.
+        bool hasContentHash;
+        size_t contentHash;
+    };
+    typedef std::map<Key, Entry> Entries;
+
+    struct SessionInputs
+    {
+        Entries entries;
+        // The last released input of each type. When the nodes sharing an
+        // input move to a new key together, e.g. because their transform is
+        // animated, the first one to move takes the spare instead of
+        // creating a new HAPI input node.
+        std::map<Input::AssetInputType, Input *> spares;
+    };
+    typedef std::map<Util::HAPISession *, SessionInputs> Sessions;
+
+    static SessionInputs &currentSession();
+
+    static Sessions theSessions;
+};
+
 #endif
@@ -3,7 +3,7 @@
 
 #include <maya/MPxNode.h>
 
-class Input;
+#include "Input.h"
 
 class InputGeometryNode : public MPxNode
 {
@@ -37,10 +37,19 @@ public:
 
 private:
     void clearInput();
-    bool checkInput(MDataBlock &dataBlock);
+    bool checkInput(MDataBlock &dataBlock, bool &needToUpload);
+    bool computeInputKey(MDataBlock &dataBlock,
+                         Input::AssetInputType assetInputType,
+                         InputRegistry::Key &key);
+    bool sharedInputChanged(MDataBlock &dataBlock,
+                            Input::AssetInputType assetInputType);
 
 private:
     Input *myInput;
+
+    // Whether myInput is owned by InputRegistry under myInputKey.
+    bool myInputIsShared;
+    InputRegistry::Key myInputKey;
 };
 
 #endif
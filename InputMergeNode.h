@@ -5,6 +5,8 @@
 
 #include <HAPI/HAPI_Common.h>
 
+#include <vector>
+
 class InputMergeNode : public MPxNode
 {
 public:
@@ -34,6 +36,11 @@ private:
 
 private:
     HAPI_NodeId myGeometryNodeId;
+
+    // The currently connected inputs, so that only the changed inputs are
+    // reconnected.
+    std::vector<HAPI_NodeId> myInputNodeIds;
+    bool myPackBeforeMerge;
 };
 
 #endif
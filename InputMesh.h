@@ -15,6 +15,10 @@ public:
 
     virtual AssetInputType assetInputType() const;
 
+    static bool hashInputGeo(MDataBlock &dataBlock,
+                             const MPlug &plug,
+                             size_t &hash);
+
     virtual void setInputGeo(MDataBlock &dataBlock, const MPlug &plug);
 
     virtual void setInputComponents(MDataBlock &dataBlock,
@@ -38,6 +42,26 @@ protected:
     bool processShadingGroups(const MFnMesh &meshFn,
                               const MStringArray &sgNames,
                               const MObjectArray &sgCompObjs);
+
+    struct ComponentGroup
+    {
+        MString name;
+        int count;
+        // sorted and unique
+        std::vector<int> members;
+    };
+    void processComponentGroup(HAPI_GroupType groupType,
+                               int count,
+                               const ComponentGroup &group,
+                               ComponentGroup &uploadedGroup);
+
+protected:
+    // Gathered by setInputComponents() and uploaded by setInputGeo().
+    ComponentGroup myPrimComponentGroup;
+    ComponentGroup myPointComponentGroup;
+
+    ComponentGroup myUploadedPrimComponentGroup;
+    ComponentGroup myUploadedPointComponentGroup;
 };
 
 #endif
@@ -16,6 +16,9 @@ public:
     virtual void setInputGeo(MDataBlock &dataBlock, const MPlug &plug);
 
 protected:
+    // Velocity and acceleration are scaled along with the positions.
+    virtual bool preserveScaleOnTransform() const { return false; }
+
     void setAttributePointData(const char *attributeName,
                                HAPI_StorageType storage,
                                int count,
@@ -1,10 +1,18 @@
 #ifndef __InputTransformNode_h__
 #define __InputTransformNode_h__
 
+#include <maya/MMatrixArray.h>
+#include <maya/MMessage.h>
+#include <maya/MObjectArray.h>
+#include <maya/MObjectHandle.h>
 #include <maya/MPxNode.h>
+#include <maya/MStringArray.h>
 
 #include <HAPI/HAPI_Common.h>
 
+#include <unordered_map>
+#include <vector>
+
 class InputTransformNode : public MPxNode
 {
 public:
@@ -27,12 +35,57 @@ public:
 
     virtual MStatus compute(const MPlug &plug, MDataBlock &dataBlock);
 
+    virtual MStatus connectionMade(const MPlug &plug,
+                                   const MPlug &otherPlug,
+                                   bool asSrc);
+    virtual MStatus connectionBroken(const MPlug &plug,
+                                     const MPlug &otherPlug,
+                                     bool asSrc);
+
 private:
     void clearInput();
     bool checkInput(MDataBlock &dataBlock);
 
+    bool updateNames();
+
+    void watchSourceNode(const MObject &node);
+    void unwatchSourceNode(const MObject &node);
+
+    static void decomposeMatrices(const MMatrixArray &matrices,
+                                  bool preserveScale,
+                                  std::vector<float> &P,
+                                  std::vector<float> &orient,
+                                  std::vector<float> &scale);
+
+    static void nameChangedCallback(MObject &node,
+                                    const MString &str,
+                                    void *clientData);
+
 private:
     HAPI_NodeId myGeometryNodeId;
+
+    // What was last uploaded, so that only the changed attributes are sent.
+    int myPointCount;
+    std::vector<float> myP;
+    std::vector<float> myOrient;
+    std::vector<float> myScale;
+
+    // The names of the source nodes are only refreshed when a connection
+    // changes or when one of the source nodes is renamed.
+    bool myNamesDirty;
+    MStringArray myNames;
+    MObjectArray mySourceNodes;
+
+    // A name changed callback for every connected source node, with the
+    // number of connections from it. Keyed by MObjectHandle::hashCode().
+    struct SourceWatch
+    {
+        MObjectHandle node;
+        MCallbackId callbackId;
+        int connectionCount;
+    };
+    typedef std::unordered_multimap<unsigned int, SourceWatch> SourceWatches;
+    SourceWatches mySourceWatches;
 };
 
 #endif
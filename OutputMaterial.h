@@ -4,16 +4,40 @@
 #include <HAPI/HAPI_Common.h>
 
 #include <string>
+#include <unordered_map>
 
 #include <maya/MDataBlock.h>
 #include <maya/MDataHandle.h>
 #include <maya/MStatus.h>
+#include <maya/MString.h>
 #include <maya/MTime.h>
 
+// The SHOP and VOP nodes of an asset, by their paths relative to the asset.
+// It's shared by all the materials of the asset, and is built again when the
+// asset has cooked.
+class MaterialNodeIndex
+{
+public:
+    MaterialNodeIndex(HAPI_NodeId assetId);
+
+    // Called once before the materials are computed.
+    void update();
+
+    HAPI_NodeId find(const std::string &path);
+
+private:
+    void build();
+
+    HAPI_NodeId myAssetId;
+    int myCookCount;
+    bool myIsBuilt;
+    std::unordered_map<std::string, HAPI_NodeId> myNodeIds;
+};
+
 class OutputMaterial
 {
 public:
-    OutputMaterial(HAPI_NodeId assetId);
+    OutputMaterial(HAPI_NodeId assetId, MaterialNodeIndex &nodeIndex);
 
     MStatus compute(const MTime &time,
                     const MPlug &materialPlug,
@@ -23,9 +47,17 @@ public:
 
 private:
     void update(MDataHandle &materialHandle);
+    void updateParmIndices();
+
+    // Renders the texture into memory, and writes it to the folder if the
+    // image has changed since it was last written. Returns the file path, or
+    // an empty string on failure.
+    MString extractTexture(int textureParmIndex,
+                           const MString &destinationFolderPath);
 
 private:
     HAPI_NodeId myAssetId;
+    MaterialNodeIndex &myNodeIndex;
 
     std::string myNodePath;
 
@@ -33,6 +65,20 @@ private:
     HAPI_NodeInfo myNodeInfo;
     int myMaterialLastCookCount;
     bool myBakeTexture;
+
+    // Where the ogl_* parms of the material node are. They only need to be
+    // found again when the node or its parm layout changes.
+    HAPI_NodeId myParmIndicesNodeId;
+    int myParmIndicesParmCount;
+    int myAmbientFloatIndex;
+    int myDiffuseFloatIndex;
+    int myAlphaFloatIndex;
+    int mySpecularFloatIndex;
+    int myTextureParmIndex;
+    int myTextureStringIndex;
+
+    std::string myTexturePath;
+    size_t myTextureHash;
 };
 
 #endif
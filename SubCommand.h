@@ -44,6 +44,7 @@ protected:
                       " Check the OTL file path and asset name.",              \
                       assetNodeFn.name());                                     \
         return MStatus::kFailure;                                              \
-    }
+    }                                                                          \
+    Util::ScopedHAPISession scopedSession(asset->getSession());
 
 #endif
@@ -3,10 +3,13 @@
 
 #include <maya/MDagModifier.h>
 #include <maya/MObjectArray.h>
+#include <maya/MObjectHandle.h>
 #include <maya/MPlug.h>
 
 #include "SubCommand.h"
 
+#include <vector>
+
 class SyncOutputGeometryPart : public SubCommand
 {
 public:
@@ -45,6 +48,11 @@ protected:
     MStatus createOutputGroups(const MObject &dstNode,
                                std::vector<bool> *hasMaterials = NULL);
 
+    void addSetMember(const MObject &setObj,
+                      const MObject &node,
+                      const MObject &componentObj = MObject::kNullObj);
+    MStatus addSetMembers();
+
 protected:
     // This is the output plug from the asset node that represents an object
     // eg. (assetNode.objects[1])
@@ -58,6 +66,17 @@ protected:
     MObject myPartTransform;
     MObjectArray myPartShapes;
 
+    // Set memberships can't be added through the modifier. They are added
+    // directly whenever the modifier is done or redone.
+    struct SetMember
+    {
+        MObjectHandle set;
+        MString setName;
+        MObject node;
+        MObject component;
+    };
+    std::vector<SetMember> mySetMembers;
+
     bool myIsInstanced;
 };
 
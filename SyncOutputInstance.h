@@ -2,16 +2,62 @@
 #define __SyncOutputInstance_h__
 
 #include <maya/MDagModifier.h>
+#include <maya/MDagPath.h>
 #include <maya/MPlug.h>
 
 #include "SubCommand.h"
 
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
 class SyncOutputInstance : public SubCommand
 {
 public:
+    // The transforms below the asset node, for finding the objects to
+    // instance by the start of their names, and the object transforms by
+    // their exact names. The DAG is walked only once per sync, before any
+    // instancer adds its own transforms.
+    class SourceIndex
+    {
+    public:
+        SourceIndex(const MObject &assetNodeObj);
+
+        // Returns the depth first order of the first transform whose name
+        // starts with the prefix, or -1 if there is none.
+        int find(const MString &prefix);
+
+        const MDagPath &dagPath(int order) const { return myDagPaths[order]; }
+
+        // Returns the child of the asset node with the name, or a null
+        // object if there is none.
+        MObject findChild(const MString &name);
+
+    private:
+        void build();
+
+        const MObject myAssetNodeObj;
+        bool myIsBuilt;
+
+        // name -> depth first order, for the first transform with the name
+        typedef std::map<std::string, unsigned int> Names;
+        Names myNames;
+        std::vector<MDagPath> myDagPaths;
+
+        // name -> direct child of the asset node
+        typedef std::map<std::string, MObject> Children;
+        Children myChildren;
+
+        // prefix -> depth first order, or -1 if nothing matches
+        typedef std::map<std::string, int> Lookups;
+        Lookups myLookups;
+    };
+
     SyncOutputInstance(const MPlug &outputPlug,
                        const int parentMultiIndex,
-                       const MObject &assetNodeObj);
+                       const MObject &assetNodeObj,
+                       SourceIndex &sourceIndex);
     virtual ~SyncOutputInstance();
 
     virtual MStatus doIt();
@@ -23,18 +69,11 @@ public:
 protected:
     MStatus createOutput();
 
-    bool instanceObjects(MObject searchRoot,
-                         MObject instancerTransform,
-                         int pointIndex,
-                         const MString &objectToInstanceName,
-                         const MString &houdiniInstanceAttr,
-                         const MString &houdiniNameAttr);
-
-    void instanceObject(MDagPath &objToInstance,
-                        MObject instancerTransform,
-                        int pointIndex);
-
-    bool stringStartsWith(const MString &string, const MString &startsWith);
+    MStatus createInstance(const MDagPath &objToInstance,
+                           const MObject &instancerTransform,
+                           const MPlug &outputTransformPlug,
+                           int pointIndex,
+                           MObject &instanceTransform);
 
 protected:
     // This is the output plug from the asset node that is connected
@@ -48,7 +87,15 @@ protected:
     // to effectively evaluate any of the multi-attributes
     const int myParentMultiIndex;
 
+    SourceIndex &mySourceIndex;
+
     MDagModifier myDagModifier;
+
+    // (instance transform, instanced child) pairs. They are added with
+    // MFnDagNode::addChild() after myDagModifier is done, so undoIt() and
+    // redoIt() have to remove and add them again.
+    typedef std::vector<std::pair<MObject, MObject> > InstancedChildren;
+    InstancedChildren myInstancedChildren;
 };
 
 #endif
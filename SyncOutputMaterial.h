@@ -13,6 +13,9 @@ public:
                                         const MObject &assetObj,
                                         int nodeId);
 
+    static MPlug findOutputMaterialPlug(const MObject &assetObj,
+                                        int nodeId,
+                                        size_t *lastLogicalElement = NULL);
     static MPlug createOutputMaterialPlug(MDGModifier &dgModifier,
                                           const MObject &assetObj,
                                           int nodeId);
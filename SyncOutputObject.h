@@ -25,6 +25,17 @@ public:
 
     virtual bool isUndoable() const;
 
+    const MObject &objectTransform() const { return myObjectTransform; }
+
+    // Hash of everything in the output plugs that decides which nodes a sync
+    // creates for the object. The data that flows through the connections is
+    // not part of it. complete is set to false if some of the material plugs
+    // that it looks at are only created by the sync.
+    static size_t signature(const MPlug &outputPlug,
+                            const bool visible,
+                            const bool syncTemplatedGeos,
+                            bool *complete = NULL);
+
 protected:
 #if MAYA_API_VERSION >= 201400
     MStatus createFluidShape(const MObject &objectTransform);
@@ -37,6 +48,8 @@ protected:
 
     MDagModifier myDagModifier;
 
+    MObject myObjectTransform;
+
     typedef std::vector<SyncOutputGeometryPart *> AssetSyncs;
     AssetSyncs myAssetSyncs;
 };
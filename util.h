@@ -15,10 +15,13 @@
 #include <algorithm>
 #include <cassert>
 #include <errno.h>
+#include <functional>
 #include <iosfwd>
 #include <memory>
+#include <mutex>
 #include <stdio.h>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #ifdef _WIN32
 #include <direct.h>
@@ -39,7 +42,7 @@
         {                                                                      \
             msg.format("^1s", __VA_ARGS__);                                    \
         }                                                                      \
-        MGlobal::displayMethod(msg);                                           \
+        Util::displayMessage(&MGlobal::displayMethod, msg);                    \
     }
 
 #define DISPLAY_ERROR(...) DISPLAY_MSG(displayError, __VA_ARGS__)
@@ -123,9 +126,80 @@ public:
             HAPI_CloseSession(this);
         }
     }
+
+    // Held by ScopedHAPISession.
+    std::recursive_mutex myMutex;
+};
+
+// The session that HAPI calls are made in. This is normally the main session,
+// but an asset that lives in a pooled session binds that session with
+// ScopedHAPISession for the calls that are made on its behalf. The binding is
+// per thread.
+class CurrentHAPISession
+{
+public:
+    HAPISession *get() const;
+    HAPISession *getMain() const { return myMainSession.get(); }
+
+    // Replaces the main session.
+    void reset(HAPISession *session = NULL);
+
+private:
+    std::unique_ptr<HAPISession> myMainSession;
+};
+
+extern CurrentHAPISession theHAPISession;
+
+// Extra sessions that independent assets can be cooked in, so that they don't
+// have to wait for each other.
+class HAPISessionPool
+{
+public:
+    // Takes ownership of the session.
+    void add(HAPISession *session);
+
+    // Cleans up and closes all the sessions. The session objects are kept
+    // alive, so that assets that still refer to them fail gracefully.
+    void close();
+
+    size_t size() const { return mySessions.size(); }
+    HAPISession *get(size_t i) const { return mySessions[i].get(); }
+
+    // Returns the open session with the fewest assets, or NULL if there is
+    // none.
+    HAPISession *acquire();
+    void release(HAPISession *session);
+
+private:
+    std::vector<std::unique_ptr<HAPISession>> mySessions;
+    std::vector<int> myUseCounts;
 };
 
-extern std::unique_ptr<HAPISession> theHAPISession;
+extern HAPISessionPool theHAPISessionPool;
+
+// Makes HAPI calls on the current thread go to session until the end of the
+// scope. A NULL session means the main session. The session is also locked
+// until the end of the scope, so that nodes in different sessions can be
+// evaluated at the same time, while nodes in the same session wait for each
+// other. Nodes have to access their session through this in compute().
+class ScopedHAPISession
+{
+public:
+    explicit ScopedHAPISession(HAPISession *session);
+    ~ScopedHAPISession();
+
+private:
+    HAPISession *myPreviousSession;
+    HAPISession *myLockedSession;
+};
+
+// Whether this is the thread that the plug-in was loaded in. Maya's UI can
+// only be used from that thread.
+bool isMainThread();
+
+// Used by the DISPLAY_* macros. Messages from other threads are displayed
+// when Maya is idle.
+void displayMessage(void (*display)(const MString &), const MString &msg);
 
 #ifdef _WIN32
 bool mkpath(const std::string &path);
@@ -138,6 +212,15 @@ extern const char *pathSeparator;
 
 std::string getTempDir();
 
+// Unlike the filetest command, this can be used from any thread.
+bool fileExists(const std::string &path);
+
+// The sourceImages folder of the current workspace. The workspace can only be
+// queried in the main thread, so the folder is cached when the plugin is
+// loaded and whenever the workspace changes.
+MString getSourceImagesDir();
+void updateSourceImagesDir();
+
 void displayInfoForNode(const MString &typeName, const MString &message);
 void displayWarningForNode(const MString &typeName, const MString &message);
 void displayErrorForNode(const MString &typeName, const MString &message);
@@ -146,6 +229,16 @@ void markItemNameUsed(const std::string &itemName,
 bool isItemNameUsed(const std::string &itemName,
                     std::vector<std::string> &itemNamesUsed);
 
+template <typename T>
+inline void
+hashCombine(size_t &seed, const T &value)
+{
+    seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+void hashBytes(size_t &seed, const void *data, size_t size);
+void hashString(size_t &seed, const MString &str);
+
 template <size_t N>
 struct CacheImpl;
 
@@ -336,6 +429,10 @@ public:
 
     bool isInterrupted();
 
+    // Returns true if the progress should be updated. This avoids fetching
+    // the progress when it won't be displayed anyway.
+    bool isUpdateDue();
+
 protected:
     bool isShowing() const;
 
@@ -352,6 +449,7 @@ protected:
 private:
     double myWaitTimeBeforeShowing;
     bool myIsShowing;
+    double myLastUpdateTime;
     MTimer myTimer;
 };
 
@@ -394,6 +492,28 @@ private:
 
 bool statusCheckLoop(bool wantMainProgressBar = true);
 
+// Counters for statusCheckLoop(), used to measure the cost of waiting for
+// cooks.
+struct StatusCheckStats
+{
+    StatusCheckStats();
+    void reset();
+
+    // Adds the counters of a single statusCheckLoop(). Can be called from
+    // any thread.
+    void add(const StatusCheckStats &stats);
+
+    // number of calls to statusCheckLoop()
+    unsigned int myWaits;
+    // number of HAPI_STATUS_COOK_STATE checks
+    unsigned int myPolls;
+    // number of times the progress and status string were fetched
+    unsigned int myProgressUpdates;
+    // total time spent in statusCheckLoop(), in seconds
+    double myWaitTime;
+};
+extern StatusCheckStats theStatusCheckStats;
+
 MString getNodeName(const MObject &nodeObj);
 MObject findNodeByName(const MString &name,
                        MFn::Type expectedFn = MFn::kInvalid);
@@ -435,6 +555,25 @@ private:
 void walkParm(const std::vector<HAPI_ParmInfo> &parmInfos,
               WalkParmOperation &operation);
 
+// A deduplicated set of parm attributes. It's indexed by the attribute names
+// and the names of their parent attributes, so that the parm walks can check
+// whether a parm is in the set without looking up any plugs.
+class ParmAttributeSet
+{
+public:
+    void add(const MObject &attr);
+    void clear();
+    bool empty() const;
+    void swap(ParmAttributeSet &other);
+
+    bool contains(const MString &attrName) const;
+    bool containsChildOf(const MString &attrName) const;
+
+private:
+    std::unordered_set<std::string> myAttrNames;
+    std::unordered_set<std::string> myParentAttrNames;
+};
+
 template <typename T, typename U>
 T
 convert(const U &src)